@@ -8,20 +8,32 @@ struct Config
     bool fibonacciImg ;
     bool montecarloconstpdfImg ;
     bool montecarlodirectLiImg ;
+    bool pathtracingImg ;
 
     bool withsky ;
     bool bdrf;
     int N;
+    int maxDepth;
+
+    int frames;
+    int orbitStep;
+    bool temporalReuse;
     Config(){
         noShadowsImg = false ;
         barycentriqueImg = false;
         fibonacciImg = false;
         montecarloconstpdfImg = false;
         montecarlodirectLiImg = true;
+        pathtracingImg = false;
 
         bdrf = true;
         withsky = false;
         N = 64 ;
+        maxDepth = 5 ;
+
+        frames = 1 ;
+        orbitStep = 5 ;
+        temporalReuse = false ;
     }
 };
 bool read_config(const std::string& filename, Config& cfg);
\ No newline at end of file
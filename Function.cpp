@@ -38,7 +38,20 @@ Vector mont_car_dir(const float u1, const float u2)
                   cos_theta);
 }
 
+//Monte Carlo PDF proportionnelle au cosinus
+Vector mont_car_cos_sampl_dir(Sampler& rng)
+{
+    float u1 = rng.sample();
+    float u2 = rng.sample();
+
+    float cos_theta = std::sqrt(u1);
+    float sin_theta = std::sqrt(std::max(0.0f, 1.0f - u1));
+    float phi = 2.0f * float(M_PI) * u2;
 
+    return Vector(std::cos(phi) * sin_theta,
+                  std::sin(phi) * sin_theta,
+                  cos_theta);
+}
 
 
 float epsilon_point( const Point& p )
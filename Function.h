@@ -1,6 +1,8 @@
 #pragma once
 #include "vec.h"
 #include "mesh.h"
+#include "mat.h"
+#include <vector>
 #include <cfloat>
 #include <math.h>
 #include <limits>
@@ -33,9 +35,10 @@ struct Hit
     float t;            // p(t)= o + td, position du point d'intersection sur le rayon
     float u, v;         // p(u, v), position du point d'intersection sur le triangle
     int triangle_id;    // indice du triangle dans le mesh
+    int instance_id;    // indice de l'instance dans la scene
     
-    Hit( ) : t(FLT_MAX), u(), v(), triangle_id(-1) {}
-    Hit( const float _t, const float _u, const float _v, const int _id ) : t(_t), u(_u), v(_v), triangle_id(_id) {}
+    Hit( ) : t(FLT_MAX), u(), v(), triangle_id(-1), instance_id(-1) {}
+    Hit( const float _t, const float _u, const float _v, const int _id ) : t(_t), u(_u), v(_v), triangle_id(_id), instance_id(-1) {}
     
     // renvoie vrai si intersection
     operator bool ( ) { return (triangle_id != -1); }
@@ -119,21 +122,20 @@ struct Source {
     
     Point position;       
     Color emission;       
-    int triangleId;       
     Vector n;             
     Point a;              
     Point b;              
     Point c;              
     float area;           
 
-    Source(const TriangleData& t_data, const Color& e, int id)
+    // triangle deja place dans le repere du monde (instance transformee)
+    Source(const Point& _a, const Point& _b, const Point& _c, const Color& e)
         : position(),
           emission(e),
-          triangleId(id),
           n(),
-          a(t_data.a),
-          b(t_data.b),
-          c(t_data.c){
+          a(_a),
+          b(_b),
+          c(_c){
         Vector ng = cross(Vector(a, b), Vector(a, c));
         n = normalize(ng);
         area = length(ng) / 2;
@@ -160,6 +162,32 @@ struct Source {
     }
 };
 
+// geometrie partagee par plusieurs instances, dans son repere local
+struct Object
+{
+    Mesh mesh;
+    std::vector<Triangle> triangles;
+
+    Object( const Mesh& _mesh ) : mesh(_mesh), triangles()
+    {
+        int n= mesh.triangle_count();
+        triangles.reserve(n);
+        for(int i= 0; i < n; i++)
+            triangles.emplace_back(mesh.triangle(i), i);
+    }
+};
+
+// placement d'un objet dans la scene
+struct Instance
+{
+    int object;         // indice de l'objet partage
+    Transform model;    // repere local -> monde
+    Transform inv;      // monde -> repere local
+    Transform normal;   // transformation des normales
+
+    Instance( const int _object, const Transform& _model ) : object(_object), model(_model), inv(Inverse(_model)), normal(_model.normal()) {}
+};
+
 struct World
 {
     World( ) : t(), b(), n() {}
@@ -209,6 +237,10 @@ inline float mont_car_const_pdf(){
     return 1 / float(2 * M_PI);
 }
 
+inline float mont_car_cos_pdf(const float cos_theta){
+    return cos_theta / float(M_PI);
+}
+
 
 //DECL
 float epsilon_point( const Point& p );
@@ -217,4 +249,5 @@ Vector normal( const Mesh& mesh, const Hit& hit );
 
 Vector mont_car_dir( const float u1, const float u2 );
 Vector mont_car_sampl_dir(Sampler& rng) ;
+Vector mont_car_cos_sampl_dir(Sampler& rng) ;
 
@@ -1,6 +1,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include "Config.h"
 
 bool read_config(const std::string& filename, Config& cfg)
@@ -32,10 +33,27 @@ bool read_config(const std::string& filename, Config& cfg)
         else if(key == "fibonacciImg")      cfg.fibonacciImg     = (value != 0);
         else if(key == "montecarloconstpdfImg") cfg.montecarloconstpdfImg = (value != 0);
         else if(key == "montecarlodirectLiImg") cfg.montecarlodirectLiImg = (value != 0);
+        else if(key == "pathtracingImg")    cfg.pathtracingImg   = (value != 0);
 
         else if(key == "withsky") cfg.withsky = (value != 0);
         else if(key == "bdrf")    cfg.bdrf    = (value != 0);
         else if(key == "N")       cfg.N       = value;
+        else if(key == "maxDepth")
+        {
+            if(value < 1)
+                std::cerr << "maxDepth invalide (" << value << "), valeur par defaut " << cfg.maxDepth << std::endl;
+            else
+                cfg.maxDepth = value;
+        }
+
+        else if(key == "frames")
+        {
+            if(value < 1)
+                std::cerr << "frames invalide (" << value << "), une seule image" << std::endl;
+            cfg.frames = std::max(value, 1);
+        }
+        else if(key == "orbitStep")     cfg.orbitStep     = value;
+        else if(key == "temporalReuse") cfg.temporalReuse = (value != 0);
     }
 
     in.close();
@@ -0,0 +1,108 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <map>
+#include "Scene.h"
+#include "wavefront.h"
+
+bool read_scene(const std::string& filename, Scene& scene)
+{
+    std::ifstream in(filename);
+    if(!in)
+    {
+        std::cerr << "Impossible d'open le fichier " << filename << std::endl;
+        return false;
+    }
+
+    // un objet par fichier .obj, partage par tous les noms et toutes les instances qui le referencent
+    std::map<std::string, int> files;
+    std::map<std::string, int> objects;
+    int instances = 0;
+
+    std::string line;
+    while(std::getline(in, line))
+    {
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream iss(line);
+        std::string key;
+        if(!(iss >> key))
+            continue;
+
+        if(key == "object")
+        {
+            // object <nom> <fichier.obj>
+            std::string name, obj;
+            if(!(iss >> name >> obj))
+            {
+                std::cerr << "Ligne object invalide : " << line << std::endl;
+                continue;
+            }
+
+            if(objects.count(name))
+            {
+                std::cerr << "Objet deja defini : " << name << std::endl;
+                continue;
+            }
+
+            auto it = files.find(obj);
+            if(it != files.end())
+            {
+                objects[name] = it->second;
+                continue;
+            }
+
+            Mesh mesh = read_mesh(obj.c_str());
+            if(mesh.triangle_count() == 0)
+            {
+                std::cerr << "Objet " << name << " vide : " << obj << std::endl;
+                continue;
+            }
+            files[obj] = objects[name] = scene.addObject(mesh);
+        }
+        else if(key == "instance")
+        {
+            // instance <nom> tx ty tz rx ry rz echelle
+            std::string name;
+            float tx, ty, tz, rx, ry, rz, s;
+            if(!(iss >> name >> tx >> ty >> tz >> rx >> ry >> rz >> s))
+            {
+                std::cerr << "Ligne instance invalide : " << line << std::endl;
+                continue;
+            }
+
+            // une echelle negative retournerait l'orientation des sources
+            if(s <= 0)
+            {
+                std::cerr << "Echelle nulle ou negative pour l'instance de " << name << std::endl;
+                continue;
+            }
+
+            auto it = objects.find(name);
+            if(it == objects.end())
+            {
+                std::cerr << "Objet inconnu : " << name << std::endl;
+                continue;
+            }
+
+            Transform model = Translation(tx, ty, tz) * RotationZ(rz) * RotationY(ry) * RotationX(rx) * Scale(s, s, s);
+            scene.addInstance(it->second, model);
+            instances++;
+        }
+    }
+
+    in.close();
+
+    if(instances == 0)
+    {
+        std::cerr << "Aucune instance dans " << filename << std::endl;
+        return false;
+    }
+    if(!scene.build())
+    {
+        std::cerr << "Aucune instance emissive dans " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
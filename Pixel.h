@@ -0,0 +1,16 @@
+#pragma once
+#include "color.h"
+#include <cfloat>
+
+
+// historique d'un pixel conserve d'une image a la suivante
+struct Pixel
+{
+    Color radiance;     // moyenne des echantillons accumules
+    int count;          // nombre d'echantillons accumules
+    float t;            // position de l'intersection sur le rayon du pixel
+    int triangle_id;    // triangle vu par le pixel
+    int instance_id;    // instance vue par le pixel
+
+    Pixel( ) : radiance(Black()), count(0), t(FLT_MAX), triangle_id(-1), instance_id(-1) {}
+};
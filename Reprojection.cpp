@@ -0,0 +1,101 @@
+#include "Reprojection.h"
+
+Reprojection::Reprojection(int width, int height)
+    : m_Width_(width), m_Height_(height),
+      m_Previous_(width * height), m_Current_(width * height),
+      m_PrevProjection_(), m_PrevInv_(), m_HasPrevious_(false)
+{
+}
+
+Reprojection::~Reprojection()
+{
+}
+
+// renvoie vrai si le pixel (x, y) de l'image precedente voyait le point p :
+// meme triangle, et point reconstruit a moins de quelques pixels de p
+bool Reprojection::valid(int x, int y, const Point &p, const Hit &hit) const
+{
+    if (x < 0 || x >= m_Width_ || y < 0 || y >= m_Height_)
+        return false;
+
+    const Pixel &pixel = m_Previous_[y * m_Width_ + x];
+    if (pixel.count == 0 || pixel.triangle_id != hit.triangle_id || pixel.instance_id != hit.instance_id)
+        return false;
+
+    // point vu par le centre du pixel, et par le centre du pixel voisin a la meme position sur le rayon
+    Point o = m_PrevInv_(Point(x + float(0.5), y + float(0.5), 0));
+    Point e = m_PrevInv_(Point(x + float(0.5), y + float(0.5), 1));
+    Point o1 = m_PrevInv_(Point(x + float(1.5), y + float(0.5), 0));
+    Point e1 = m_PrevInv_(Point(x + float(1.5), y + float(0.5), 1));
+    Point q = o + pixel.t * Vector(o, e);
+    Point q1 = o1 + pixel.t * Vector(o1, e1);
+
+    // taille du pixel sur la surface
+    float footprint = distance(q, q1);
+    return distance(p, q) <= FOOTPRINT_TOLERANCE * footprint;
+}
+
+// renvoie le nombre d'echantillons reutilisables pour le point p et leur moyenne,
+// interpolee entre les 4 pixels les plus proches dans l'image precedente,
+// 0 si le point n'y etait pas visible
+int Reprojection::reproject(const Point &p, const Hit &hit, Color &radiance) const
+{
+    if (!m_HasPrevious_)
+        return 0;
+
+    // position du point dans l'image precedente
+    Point q = m_PrevProjection_(p);
+    if (q.z < 0 || q.z > 1)
+        return 0;
+
+    float fx = q.x - float(0.5);
+    float fy = q.y - float(0.5);
+    int x = int(std::floor(fx));
+    int y = int(std::floor(fy));
+    float u = fx - x;
+    float v = fy - y;
+
+    Color sum = Black();
+    float count = 0;
+    float weight = 0;
+    for (int j = 0; j < 2; j++)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            float w = (i ? u : 1 - u) * (j ? v : 1 - v);
+            if (w <= 0 || !valid(x + i, y + j, p, hit))
+                continue;
+
+            const Pixel &pixel = m_Previous_[(y + j) * m_Width_ + (x + i)];
+            sum = sum + pixel.radiance * w;
+            count = count + pixel.count * w;
+            weight = weight + w;
+        }
+    }
+
+    // pas assez de voisins valides pour interpoler
+    if (weight < MIN_WEIGHT)
+        return 0;
+
+    radiance = Color(sum / weight, 1);
+    return int(count / weight);
+}
+
+void Reprojection::store(int x, int y, const Color &radiance, int count, const Hit &hit)
+{
+    Pixel &pixel = m_Current_[y * m_Width_ + x];
+    pixel.radiance = radiance;
+    pixel.count = count;
+    pixel.t = hit.t;
+    pixel.triangle_id = hit.triangle_id;
+    pixel.instance_id = hit.instance_id;
+}
+
+// l'image courante devient l'historique de la suivante
+void Reprojection::swap(const Transform &projection, const Transform &inv)
+{
+    std::swap(m_Previous_, m_Current_);
+    m_PrevProjection_ = projection;
+    m_PrevInv_ = inv;
+    m_HasPrevious_ = true;
+}
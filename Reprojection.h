@@ -0,0 +1,31 @@
+#pragma once
+#include "Function.h"
+#include "Pixel.h"
+#include <vector>
+
+
+// cache de l'image precedente : reprojette les points vus par la nouvelle camera
+// dans l'ancienne image et reutilise les echantillons deja calcules
+class Reprojection
+{
+    private:
+        int m_Width_;
+        int m_Height_;
+        std::vector<Pixel> m_Previous_;
+        std::vector<Pixel> m_Current_;
+        Transform m_PrevProjection_;    // monde -> image precedente
+        Transform m_PrevInv_;           // image precedente -> monde
+        bool m_HasPrevious_;
+
+        bool valid(int x, int y, const Point& p, const Hit& hit) const;
+
+    public:
+        Reprojection(int width, int height);
+        ~Reprojection();
+        int reproject(const Point& p, const Hit& hit, Color& radiance) const;
+        void store(int x, int y, const Color& radiance, int count, const Hit& hit);
+        void swap(const Transform& projection, const Transform& inv);
+
+        static constexpr float FOOTPRINT_TOLERANCE = 2.0f; //Distance acceptee, en pixels sur la surface
+        static constexpr float MIN_WEIGHT = 0.5f; //Poids bilineaire minimum des voisins valides
+};
@@ -2,25 +2,74 @@
 #include <fstream>
 #include <set>
 
-Scene::Scene(const Mesh &mesh) : m_Mesh_(mesh), m_NbrTriangles(m_Mesh_.triangle_count())
+Scene::Scene() : m_NbrTriangles(0)
 {
-    for (int i = 0; i < m_NbrTriangles; i++)
-    {
-        const TriangleData &t_data = m_Mesh_.triangle(i);
-        m_Triangles_.emplace_back(t_data, i);
+}
+
+Scene::Scene(const Mesh &mesh) : m_NbrTriangles(0)
+{
+    addObject(mesh);
+    addInstance(0, Identity());
+    build();
+    assert(m_Sources_.size() > 0);
+}
+
+Scene::~Scene()
+{
+}
+
+int Scene::addObject(const Mesh &mesh)
+{
+    m_Objects_.emplace_back(mesh);
+    return int(m_Objects_.size()) - 1;
+}
 
-        const Material &material = m_Mesh_.triangle_material(i);
+void Scene::addInstance(int object, const Transform &model)
+{
+    assert(object >= 0 && object < int(m_Objects_.size()));
+    m_Instances_.emplace_back(object, model);
+}
 
-        if (material.emission.r + material.emission.g + material.emission.b > 0)
+// place les sources de chaque instance emissive dans le repere du monde
+// renvoie faux si la scene ne contient aucune source
+bool Scene::build()
+{
+    m_Sources_.clear();
+    m_NbrTriangles = 0;
+    for (const Instance &instance : m_Instances_)
+    {
+        const Object &object = m_Objects_[instance.object];
+        m_NbrTriangles += int(object.triangles.size());
+
+        for (int i = 0; i < int(object.triangles.size()); i++)
         {
-            m_Sources_.emplace_back(t_data, material.emission, i);
+            const Material &material = object.mesh.triangle_material(i);
+
+            if (material.emission.r + material.emission.g + material.emission.b > 0)
+            {
+                const TriangleData &t_data = object.mesh.triangle(i);
+                m_Sources_.emplace_back(instance.model(Point(t_data.a)), instance.model(Point(t_data.b)), instance.model(Point(t_data.c)), material.emission);
+            }
         }
     }
-    assert(m_Sources_.size() > 0);
+    return m_Sources_.size() > 0;
 }
 
-Scene::~Scene()
+const Mesh &Scene::mesh(const Hit &hit) const
 {
+    return m_Objects_[m_Instances_[hit.instance_id].object].mesh;
+}
+
+const Material &Scene::material(const Hit &hit) const
+{
+    return mesh(hit).triangle_material(hit.triangle_id);
+}
+
+// normale du point d'intersection dans le repere du monde
+Vector Scene::normal(const Hit &hit) const
+{
+    const Instance &instance = m_Instances_[hit.instance_id];
+    return normalize(instance.normal(::normal(mesh(hit), hit)));
 }
 
 Hit Scene::occluded(const Point &p, const Vector &n, const Vector &d)
@@ -34,14 +83,24 @@ Hit Scene::closestOccluded(const Point &p, const Vector &n, const Vector &d)
     return this->closestHit(ray, ray.tmax);
 }
 
+// le rayon est transforme dans le repere de chaque instance, t reste le meme
 Hit Scene::intersect(const Ray &ray, const float tmax)
 {
-
-    for (int j = 0; j < m_NbrTriangles; ++j)
+    for (int i = 0; i < int(m_Instances_.size()); ++i)
     {
-        Hit hit = m_Triangles_[j].intersect(ray, tmax);
-        if (hit)
-            return hit;
+        const Instance &instance = m_Instances_[i];
+        const Object &object = m_Objects_[instance.object];
+        Ray local(instance.inv(ray.o), instance.inv(ray.d));
+
+        for (const Triangle &triangle : object.triangles)
+        {
+            Hit hit = triangle.intersect(local, tmax);
+            if (hit)
+            {
+                hit.instance_id = i;
+                return hit;
+            }
+        }
     }
     return Hit();
 }
@@ -55,13 +114,21 @@ bool Scene::visible(const Point &p, const Point &q)
 Hit Scene::closestHit(const Ray &ray, float &tmax)
 {
     Hit hit;
-    for (int j = 0; j < m_NbrTriangles; ++j)
+    for (int i = 0; i < int(m_Instances_.size()); ++i)
     {
-        if (Hit h = m_Triangles_[j].intersect(ray, tmax))
+        const Instance &instance = m_Instances_[i];
+        const Object &object = m_Objects_[instance.object];
+        Ray local(instance.inv(ray.o), instance.inv(ray.d));
+
+        for (const Triangle &triangle : object.triangles)
         {
-            assert(h.t > 0);
-            hit = h;
-            tmax = hit.t;
+            if (Hit h = triangle.intersect(local, tmax))
+            {
+                assert(h.t > 0);
+                hit = h;
+                hit.instance_id = i;
+                tmax = hit.t;
+            }
         }
     }
     return hit;
@@ -71,8 +138,8 @@ void Scene::withoutShadow(Color &color, const Hit &hit, bool bdrf)
 {
     const Color &emission = Color(1.f, 1.f, 1.f) * I;
     const Vector &l = Vector({0.f, 1.f, 0.f, 0.f});
-    const Vector &pn = normal(m_Mesh_, hit);
-    const Color &fr = (bdrf) ? (diffuse_color(m_Mesh_, hit) / M_PI) : White() / M_PI;
+    const Vector &pn = normal(hit);
+    const Color &fr = (bdrf) ? (material(hit).diffuse / M_PI) : White() / M_PI;
     float cos_theta = std::max(0.0f, dot(normalize(pn), normalize(l)));
     color = Color((fr * emission * ((1 + cos_theta) / 2)), 1);
 }
@@ -80,12 +147,12 @@ void Scene::withoutShadow(Color &color, const Hit &hit, bool bdrf)
 void Scene::fibonacciSampling(Color &color, const Point &p, const Hit &hit, bool withsky, bool bdrf, int N)
 {
     Color emission;
-    Vector pn = normal(m_Mesh_, hit);
+    Vector pn = normal(hit);
     if (withsky)
         emission = Color(1.f, 1.f, 1.f) * 10;
     Vector f;
-    Color fr = (bdrf) ? (diffuse_color(m_Mesh_, hit) / M_PI) : White() / M_PI;
-    const Material &pmaterial = m_Mesh_.triangle_material(hit.triangle_id);
+    Color fr = (bdrf) ? (material(hit).diffuse / M_PI) : White() / M_PI;
+    const Material &pmaterial = material(hit);
     emission = emission + pmaterial.emission;
     color = Black();
 
@@ -100,11 +167,11 @@ void Scene::fibonacciSampling(Color &color, const Point &p, const Hit &hit, bool
             {
                 continue;
             }
-            const Material &material = m_Mesh_.triangle_material(h.triangle_id);
-            if (material.emission.max() > 0)
+            const Material &hmaterial = material(h);
+            if (hmaterial.emission.max() > 0)
             {
                 float cos_theta = std::max(0.0f, dot(normalize(pn), normalize(f)));
-                color = color + (fr * material.emission * cos_theta);
+                color = color + (fr * hmaterial.emission * cos_theta);
                 continue;
             }
             continue;
@@ -123,12 +190,12 @@ void Scene::montCarloConstPdf(Color &color, const Point &p, const Hit &hit, Samp
     if (withsky)
         emission = Color(1.f, 1.f, 1.f) * I;
 
-    const Vector &pn = normal(m_Mesh_, hit);
+    const Vector &pn = normal(hit);
     Vector d;
-    const Color &fr = (bdrf) ? (diffuse_color(m_Mesh_, hit) / M_PI) : White();
+    const Color &fr = (bdrf) ? (material(hit).diffuse / M_PI) : White();
     color = Black();
 
-    const Material &pmaterial = m_Mesh_.triangle_material(hit.triangle_id);
+    const Material &pmaterial = material(hit);
     emission = emission + pmaterial.emission;
 
     const World &world(pn);
@@ -145,11 +212,11 @@ void Scene::montCarloConstPdf(Color &color, const Point &p, const Hit &hit, Samp
             {
                 continue;
             }
-            const Material &material = m_Mesh_.triangle_material(h.triangle_id);
-            if (material.emission.max() > 0)
+            const Material &hmaterial = material(h);
+            if (hmaterial.emission.max() > 0)
             {
                 float cos_theta = std::max(0.0f, dot(normalize(pn), normalize(d)));
-                color = color + (fr * material.emission * v * cos_theta * (1 / pdf));
+                color = color + (fr * hmaterial.emission * v * cos_theta * (1 / pdf));
                 continue;
             }
             continue;
@@ -164,8 +231,8 @@ void Scene::montCarloAreaPdf(Color &color, const Point &p, const Hit &hit, Sampl
 {
 
     Color emission;
-    const Vector &pn = normal(m_Mesh_, hit);
-    const Color &fr = (bdrf) ? (diffuse_color(m_Mesh_, hit) / M_PI) : White();
+    const Vector &pn = normal(hit);
+    const Color &fr = (bdrf) ? (material(hit).diffuse / M_PI) : White();
     color = Black();
 
     for (int i = 0; i < N; i++)
@@ -200,3 +267,74 @@ void Scene::montCarloAreaPdf(Color &color, const Point &p, const Hit &hit, Sampl
     }
     color = Color(color / float(N), 1);
 }
+
+// chemins de maxDepth rebonds : eclairage direct (source echantillonnee) a chaque sommet,
+// direction suivante selon une pdf en cosinus, et roulette russe sur le poids du chemin
+void Scene::pathTracing(Color &color, const Ray &ray, const Hit &hit, Sampler &rng, bool bdrf, int N, int maxDepth)
+{
+    color = Black();
+    const float nbSources = float(m_Sources_.size());
+
+    for (int i = 0; i < N; i++)
+    {
+        // la camera voit directement l'emission du premier point
+        Color li = material(hit).emission;
+        Color throughput = White();
+
+        Hit h = hit;
+        Point p = ray.point(hit.t);
+        Vector o = ray.d;
+
+        for (int depth = 0; depth < maxDepth; depth++)
+        {
+            Vector pn = normal(h);
+            if (dot(pn, o) > 0)
+                pn = -pn;
+            const Color &fr = (bdrf) ? (material(h).diffuse / M_PI) : White() / M_PI;
+
+            // eclairage direct : choisir une source puis un point sur la source
+            const Source &source = m_Sources_[rng.sample_range(m_Sources_.size())];
+            const Point &q = source.sample(rng);
+            const Vector &qn = source.n;
+            float pdf = source.pdf(q) / nbSources;
+
+            float cos_theta = std::max(float(0), dot(pn, normalize(Vector(p, q))));
+            float cos_theta_q = std::max(float(0), dot(qn, normalize(Vector(q, p))));
+            if (cos_theta * cos_theta_q > 0 && visible(p + 0.001 * pn, q + 0.001 * qn))
+                li = li + throughput * source.emission * fr * cos_theta * cos_theta_q / distance2(p, q) / pdf;
+
+            // dernier sommet du chemin : pas de rebond a tracer
+            if (depth + 1 == maxDepth)
+                break;
+
+            // rebond suivant
+            const World &world(pn);
+            const Vector &local = mont_car_cos_sampl_dir(rng);
+            float pdf_d = mont_car_cos_pdf(local.z);
+            if (pdf_d <= 0)
+                break;
+            throughput = throughput * fr * (local.z / pdf_d);
+
+            // roulette russe : termine les chemins qui ne transportent plus grand chose
+            if (depth >= RR_DEPTH)
+            {
+                float survive = std::min(throughput.max(), 0.95f);
+                if (rng.sample() >= survive)
+                    break;
+                throughput = throughput / survive;
+            }
+
+            const Vector &d = world(local);
+            h = closestOccluded(p, pn, d);
+            if (!h)
+                break;
+
+            // les sources touchees par rebond sont deja comptees par l'eclairage direct
+            p = p + K * pn * epsilon_point(p) + h.t * d;
+            o = d;
+        }
+
+        color = color + li;
+    }
+    color = Color(color / float(N), 1);
+}
@@ -1,18 +1,27 @@
 #pragma once
 #include "Function.h"
+#include <string>
 
 
 
 class Scene
 {
     private:
-        Mesh m_Mesh_;
-        std::vector<Triangle> m_Triangles_;
+        std::vector<Object> m_Objects_;
+        std::vector<Instance> m_Instances_;
         std::vector<Source> m_Sources_;
 
+        const Mesh& mesh(const Hit& hit) const;
+        const Material& material(const Hit& hit) const;
+        Vector normal(const Hit& hit) const;
+
     public:
+        Scene();
         Scene(const Mesh& mesh);
         ~Scene();
+        int addObject(const Mesh& mesh);
+        void addInstance(int object, const Transform& model);
+        bool build();
         Hit occluded(const Point &p,const Vector& n, const Vector& d);
         Hit closestOccluded(const Point &p, const Vector &n, const Vector &d);
         Hit intersect(const Ray &ray, const float tmax);
@@ -22,12 +31,15 @@ class Scene
         void fibonacciSampling(Color& color,const Point& p,const Hit& hit,bool withsky,bool bdrf = true,int N = 64) ;
         void montCarloConstPdf(Color& color,const Point &p, const Hit &hit,Sampler& rng, bool withsky,bool bdrf, int N);
         void montCarloAreaPdf(Color& color,const Point &p, const Hit &hit,Sampler& rng, bool bdrf, int N);
+        void pathTracing(Color& color,const Ray &ray, const Hit &hit,Sampler& rng, bool bdrf, int N, int maxDepth);
 
         int m_NbrTriangles ;
         static const int K = 32;
         static const int I = 2; //Intensité d'une l'emission du ciel
+        static const int RR_DEPTH = 2; //Rebond a partir duquel la roulette russe est active
 
 
 };
 
+bool read_scene(const std::string& filename, Scene& scene);
 
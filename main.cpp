@@ -1,8 +1,11 @@
 //! \file tuto_rayons.cpp
 
 #include <vector>
+#include <algorithm>
 #include <cfloat>
 #include <chrono>
+#include <cstdio>
+#include <string>
 
 #include "vec.h"
 #include "mat.h"
@@ -13,9 +16,49 @@
 #include "orbiter.h"
 #include "wavefront.h"
 #include "Scene.h"
+#include "Reprojection.h"
 
 #include "Config.h"
 
+// calcule la couleur d'un pixel avec N echantillons, selon le mode choisi
+void render(Color &color, Scene *m_Scene, const Config &cfg, const Ray &ray, const Hit &hit, Sampler &rng, int N)
+{
+    Point p = ray.o + hit.t * ray.d;
+    if (cfg.barycentriqueImg)
+    {
+        color = Color(1 - hit.u - hit.v, hit.u, hit.v);
+    }
+    else if (cfg.noShadowsImg)
+    {
+        m_Scene->withoutShadow(color, hit, cfg.bdrf);
+    }
+    else if (cfg.fibonacciImg)
+    {
+        m_Scene->fibonacciSampling(color, p, hit, cfg.withsky, cfg.bdrf, N);
+
+    }
+    else if (cfg.montecarloconstpdfImg)
+    {
+        m_Scene->montCarloConstPdf(color, p, hit, rng, cfg.withsky, cfg.bdrf, N);
+
+    }
+    else if (cfg.pathtracingImg)
+    {
+        m_Scene->pathTracing(color, ray, hit, rng, cfg.bdrf, N, cfg.maxDepth);
+
+    }
+    else if (cfg.montecarlodirectLiImg)
+    {
+
+        m_Scene->montCarloAreaPdf(color, p, hit, rng, cfg.bdrf, N);
+
+    }
+    else
+    {
+        color = Black();
+    }
+}
+
 int main(const int argc, const char **argv)
 {
     Config cfg;
@@ -39,85 +82,127 @@ int main(const int argc, const char **argv)
     if (camera.read_orbiter(orbiter_filename) < 0)
         return 1;
 
-    Mesh mesh = read_mesh(mesh_filename);
-    Scene *m_Scene = new Scene(mesh);
+    // fichier .obj : un seul mesh, sinon description de scene avec instances
+    Scene *m_Scene = nullptr;
+    std::string scene_filename(mesh_filename);
+    if (scene_filename.size() > 4 && scene_filename.substr(scene_filename.size() - 4) == ".obj")
+    {
+        Mesh mesh = read_mesh(mesh_filename);
+        m_Scene = new Scene(mesh);
+    }
+    else
+    {
+        m_Scene = new Scene();
+        if (!read_scene(scene_filename, *m_Scene))
+        {
+            delete m_Scene;
+            return 1;
+        }
+    }
 
-    //
-    Image image(1024, 768) ;
+    const int width = 1024;
+    const int height = 768;
 
-    // recupere les transformations pour generer les rayons
-    camera.projection(image.width(), image.height(), 45);
-    Transform model = Identity();
-    Transform view = camera.view();
-    Transform projection = camera.projection();
-    Transform viewport = camera.viewport();
-    Transform inv = Inverse(viewport * projection * view * model);
+    // seuls les modes Monte Carlo accumulent des echantillons reutilisables
+    bool montecarlo = !cfg.barycentriqueImg && !cfg.noShadowsImg && !cfg.fibonacciImg
+        && (cfg.montecarloconstpdfImg || cfg.pathtracingImg || cfg.montecarlodirectLiImg);
+    if (cfg.temporalReuse && !montecarlo)
+        std::cerr << "temporalReuse ignore : mode sans echantillonnage Monte Carlo" << std::endl;
 
-    auto start = std::chrono::high_resolution_clock::now();
+    Reprojection *m_Cache = (cfg.temporalReuse && montecarlo) ? new Reprojection(width, height) : nullptr;
 
-    // parcours tous les pixels de l'image
-    #pragma omp parallel for schedule(dynamic, 1)
-    for (int y = 0; y < image.height(); y++)
-    {
-        std::random_device hwseed;
-        Sampler rng(hwseed());
+    // l'historique couvre au plus N - 1 echantillons : chaque image en recalcule
+    // au moins un par pixel, pour que l'historique finisse par etre remplace
+    const int maxHistory = std::max(0, cfg.N - 1);
 
-        for (int x = 0; x < image.width(); x++)
+    for (int frame = 0; frame < cfg.frames; frame++)
+    {
+        if (frame > 0)
+            camera.rotation(float(cfg.orbitStep), 0);
+
+        //
+        Image image(width, height) ;
+
+        // recupere les transformations pour generer les rayons
+        camera.projection(image.width(), image.height(), 45);
+        Transform model = Identity();
+        Transform view = camera.view();
+        Transform projection = camera.projection();
+        Transform viewport = camera.viewport();
+        Transform vp = viewport * projection * view * model;
+        Transform inv = Inverse(vp);
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // parcours tous les pixels de l'image
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int y = 0; y < image.height(); y++)
         {
-            // generer le rayon au centre du pixel
-            Point origine = inv(Point(x + float(0.5), y + float(0.5), 0));
-            Point extremite = inv(Point(x + float(0.5), y + float(0.5), 1));
-            Ray ray(origine, extremite);
-
-            // calculer les intersections avec tous les triangles
-            float tmax = ray.tmax; // extremite du rayon
-            Hit hit = m_Scene->closestHit(ray, tmax);
+            std::random_device hwseed;
+            Sampler rng(hwseed());
 
-            if (hit)
+            for (int x = 0; x < image.width(); x++)
             {
+                // generer le rayon au centre du pixel
+                Point origine = inv(Point(x + float(0.5), y + float(0.5), 0));
+                Point extremite = inv(Point(x + float(0.5), y + float(0.5), 1));
+                Ray ray(origine, extremite);
 
-                Point p = ray.o + hit.t * ray.d;
-                Color color = Black();
-                if (cfg.barycentriqueImg)
-                {
-                    image(x, y) = Color(1 - hit.u - hit.v, hit.u, hit.v);
-                }
-                else if (cfg.noShadowsImg)
-                {
-                    m_Scene->withoutShadow(image(x, y),hit, cfg.bdrf);
-                }
-                else if (cfg.fibonacciImg)
-                {
-                    m_Scene->fibonacciSampling(image(x, y),p, hit,cfg.withsky, cfg.bdrf, cfg.N);
+                // calculer les intersections avec tous les triangles
+                float tmax = ray.tmax; // extremite du rayon
+                Hit hit = m_Scene->closestHit(ray, tmax);
 
-                }
-                else if (cfg.montecarloconstpdfImg)
+                if (hit)
                 {
-                    m_Scene->montCarloConstPdf(image(x, y),p, hit, rng, cfg.withsky, cfg.bdrf, cfg.N);
-                   
+                    // reutilise l'historique valide et complete jusqu'a N echantillons
+                    Color history = Black();
+                    int count = 0;
+                    if (m_Cache)
+                        count = std::min(m_Cache->reproject(ray.point(hit.t), hit, history), maxHistory);
+
+                    int n = cfg.N - count;
+                    Color color = history;
+                    if (n > 0)
+                    {
+                        Color sample;
+                        render(sample, m_Scene, cfg, ray, hit, rng, n);
+                        color = (history * float(count) + sample * float(n)) / float(count + n);
+                    }
+                    image(x, y) = Color(color, 1);
+
+                    if (m_Cache)
+                        m_Cache->store(x, y, image(x, y), count + n, hit);
                 }
-                else if (cfg.montecarlodirectLiImg)
+                else if (m_Cache)
                 {
-
-                    m_Scene->montCarloAreaPdf(image(x, y),p, hit, rng, cfg.bdrf, cfg.N);
-
-                }
-                else
-                {
-                    color = Black();
+                    m_Cache->store(x, y, Black(), 0, hit);
                 }
-
             }
         }
-    }
 
-    auto stop = std::chrono::high_resolution_clock::now();
-    int cpu = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
-    printf("%dms\n", cpu);
+        auto stop = std::chrono::high_resolution_clock::now();
+        int cpu = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+        printf("%dms\n", cpu);
 
-    write_image(image, "render.png");
-    write_image_hdr(image, "render.hdr");
+        if (m_Cache)
+            m_Cache->swap(vp, inv);
+
+        if (cfg.frames > 1)
+        {
+            char filename[64];
+            snprintf(filename, sizeof(filename), "render_%03d.png", frame);
+            write_image(image, filename);
+            snprintf(filename, sizeof(filename), "render_%03d.hdr", frame);
+            write_image_hdr(image, filename);
+        }
+        else
+        {
+            write_image(image, "render.png");
+            write_image_hdr(image, "render.hdr");
+        }
+    }
 
+    delete m_Cache;
     delete m_Scene;
     return 0;
 }